@@ -43,8 +43,9 @@ include_paths = [ "./AnalyzerSDK/include" ]
 link_paths = [ "./AnalyzerSDK/lib" ]
 link_dependencies = [ "-lAnalyzer" ] #refers to libAnalyzer.dylib or libAnalyzer.so
 
-debug_compile_flags = "-O0 -w -c -fpic -g"
-release_compile_flags = "-O3 -w -c -fpic"
+#C++11 for std::mutex
+debug_compile_flags = "-std=c++11 -O0 -w -c -fpic -g"
+release_compile_flags = "-std=c++11 -O3 -w -c -fpic"
 
 def run_command(cmd):
     "Display cmd, then run it in a subshell, raise if there's an error"
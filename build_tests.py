@@ -0,0 +1,31 @@
+# Python 3 script to build and run the decoder regression tests
+#
+#   python build_tests.py            build, then compare against test/golden
+#   python build_tests.py --update   build, then rewrite test/golden
+#   python build_tests.py --bench    build, then report decoder throughput
+#
+# Unlike the analyzer itself, this needs nothing from the AnalyzerSDK.
+
+import os, sys
+
+def run_command(cmd):
+    "Display cmd, then run it in a subshell, raise if there's an error"
+    print(cmd)
+    if os.system(cmd):
+        raise Exception("Shell execution returned nonzero status")
+
+#the decoder state machine, plus the harness that drives it
+cpp_files = [ "source/SWDDecoder.cpp", "test/SWDDecoderTest.cpp" ]
+
+test_program = "test/swd_decoder_test"
+
+compile_flags = "-O3 -w"
+
+command = "g++ " + compile_flags + " -o\"" + test_program + "\" "
+for cpp_file in cpp_files:
+    command += "\"" + cpp_file + "\" "
+
+run_command(command)
+
+#run it, passing on any options
+run_command("\"" + test_program + "\" test/golden " + " ".join(sys.argv[1:]))
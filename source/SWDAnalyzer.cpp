@@ -33,9 +33,15 @@
 SWDAnalyzer::SWDAnalyzer()
 :	Analyzer2(),  
 	mSettings( new SWDAnalyzerSettings() ),
-	mSimulationInitialized( false )
+	mSimulationInitialized( false ),
+	mCheckpointSWDIOChannel( UNDEFINED_CHANNEL ),
+	mCheckpointSWCLKChannel( UNDEFINED_CHANNEL ),
+	mCheckpointSampleRate( 0 )
 {
 	SetAnalyzerSettings( mSettings.get() );
+
+	mLinkTiming.Reset();
+	mMinimumSafeSampleRate = 0;
 }
 
 SWDAnalyzer::~SWDAnalyzer()
@@ -50,218 +56,98 @@ void SWDAnalyzer::SetupResults()
 	mResults->AddChannelBubblesWillAppearOn( mSettings->mSWDIOChannel );
 }
 
+/* SWDEdgeWalker's view of a channel's level */
+inline bool swd_is_high( AnalyzerChannelData* channel )
+{
+	return channel->GetBitState() == BIT_HIGH;
+}
+
 void SWDAnalyzer::WorkerThread()
 {
 	mSWDIO = GetAnalyzerChannelData( mSettings->mSWDIOChannel );
 	mSWCLK = GetAnalyzerChannelData( mSettings->mSWCLKChannel );
 
-	if( mSWCLK->GetBitState() == BIT_HIGH )
-		mSWCLK->AdvanceToNextEdge();
+	if ( (mCheckpointSWDIOChannel != mSettings->mSWDIOChannel) || (mCheckpointSWCLKChannel != mSettings->mSWCLKChannel) ||
+	     (mCheckpointSampleRate != GetSampleRate()) )
+	{
+		mCheckpoints.Clear();
+		mCheckpointSWDIOChannel = mSettings->mSWDIOChannel;
+		mCheckpointSWCLKChannel = mSettings->mSWCLKChannel;
+		mCheckpointSampleRate = GetSampleRate();
+	}
+
+	/* whatever an earlier run measured doesn't apply to this one */
+	{
+		std::lock_guard< std::mutex > lock( mLinkTimingMutex );
+		mLinkTiming.Reset();
+		mMinimumSafeSampleRate = 0;
+	}
 
-	U64 current_sample, onset_sample, previous_current_sample;
-	U32 ones_count, data_count;
+	SWDDecoder decoder( this );
+	SWDEdgeWalker< AnalyzerChannelData > walker( mSWCLK, mSWDIO, &decoder, this, &mCheckpoints );
 
-	bool rise_bit, parity;
+	walker.SetRange( mSettings->mStartSample, mSettings->mEndSample );
+	walker.Run();
+}
 
-	enum state_enum
-	{
-		START,
-		APnDP,
-		RnW,
-		A0,
-		A1,
-		PARITY,
-		STOP,
-		PARK,
-		TRN,
-		ACK0,
-		ACK1,
-		ACK2,
-		ACKTRN,
-		DATA,
-		RST,
-		ENDTRN,
-	};
+void SWDAnalyzer::CommitDecoded()
+{
+	mResults->CommitResults();
+}
 
-	enum state_enum state, next_state;
+void SWDAnalyzer::ReportDecodeProgress( uint64_t sample_number )
+{
+	ReportProgress( sample_number );
+}
 
-	U8 command, ack;
-	U32 data;
+void SWDAnalyzer::PublishLinkTiming( const SWDLinkTiming& timing )
+{
+	U32 minimum_safe_sample_rate = timing.MinimumSafeSampleRate( GetSampleRate() );
 
-	state = RST;
-	ones_count = 6;
-	previous_current_sample = 0;
+	std::lock_guard< std::mutex > lock( mLinkTimingMutex );
+	mLinkTiming = timing;
+	mMinimumSafeSampleRate = minimum_safe_sample_rate;
+}
+
+SWDLinkTiming SWDAnalyzer::GetLinkTiming() const
+{
+	std::lock_guard< std::mutex > lock( mLinkTimingMutex );
+	return mLinkTiming;
+}
 
-	for( ; ; )
+void SWDAnalyzer::AddMarker( uint64_t sample_number, SWDMarker marker )
+{
+	/* in the order of SWDMarker */
+	static const AnalyzerResults::MarkerType marker_types[] =
 	{
-		mSWCLK->AdvanceToNextEdge(); // rising edge
-		current_sample = mSWCLK->GetSampleNumber();
-
-		mSWDIO->AdvanceToAbsPosition(current_sample - 1);
-		rise_bit = mSWDIO->GetBitState() == BIT_HIGH;
-
-		Frame frame;
-
-#if 1
-		/* method of jump-starting decoding if capture doesn't include 50 ones */
-		if ( (current_sample - previous_current_sample) > 10000 )
-			state = START;
-#endif
-
-		switch (state)
-		{
-		case START:
-			next_state = (rise_bit) ? APnDP : START;
-			if (rise_bit)
-			{
-				mResults->AddMarker( current_sample, AnalyzerResults::Start, mSettings->mSWDIOChannel );
-				onset_sample = current_sample;	
-			}
-			break;
-		case APnDP:
-			parity = rise_bit;
-			next_state = RnW;
-			command &= 0x7;
-			if (rise_bit)
-				command |= 0x8;
-			mResults->AddMarker( current_sample, (rise_bit) ? AnalyzerResults::One : AnalyzerResults::Zero, mSettings->mSWDIOChannel );
-			break;
-		case RnW:
-			parity ^= rise_bit;
-			next_state = A0;
-			command &= 0xB;
-			if (rise_bit)
-				command |= 0x4;
-			mResults->AddMarker( current_sample, (rise_bit) ? AnalyzerResults::One : AnalyzerResults::Zero, mSettings->mSWDIOChannel );
-			break;
-		case A0:
-			parity ^= rise_bit;
-			next_state = A1;
-			command &= 0xE;
-			if (rise_bit)
-				command |= 0x1;
-			mResults->AddMarker( current_sample, (rise_bit) ? AnalyzerResults::One : AnalyzerResults::Zero, mSettings->mSWDIOChannel );
-			break;
-		case A1:
-			parity ^= rise_bit;
-			next_state = PARITY;
-			command &= 0xD;
-			if (rise_bit)
-				command |= 0x2;
-			mResults->AddMarker( current_sample, (rise_bit) ? AnalyzerResults::One : AnalyzerResults::Zero, mSettings->mSWDIOChannel );
-			break;
-		case PARITY:
-			next_state = (parity == rise_bit) ? STOP : RST;
-			mResults->AddMarker( current_sample, (parity == rise_bit) ? AnalyzerResults::Dot : AnalyzerResults::ErrorDot, mSettings->mSWDIOChannel );
-			break;
-		case STOP:
-			next_state = (rise_bit) ? RST : PARK;
-			mResults->AddMarker( current_sample, (rise_bit) ? AnalyzerResults::ErrorDot : AnalyzerResults::Stop, mSettings->mSWDIOChannel );
-			break;
-		case PARK:
-			next_state = (rise_bit) ? TRN : RST;
-			break;
-		case TRN:
-			mResults->AddMarker( current_sample, AnalyzerResults::Square, mSettings->mSWDIOChannel );
-			next_state = ACK0;
-			break;
-		case ACK0:
-			next_state = ACK1;
-			ack &= 0x6;
-			if (rise_bit)
-				ack |= 0x1;
-			mResults->AddMarker( current_sample, (rise_bit) ? AnalyzerResults::One : AnalyzerResults::Zero, mSettings->mSWDIOChannel );
-			break;
-		case ACK1:
-			next_state = ACK2;
-			ack &= 0x5;
-			if (rise_bit)
-				ack |= 0x2;
-			mResults->AddMarker( current_sample, (rise_bit) ? AnalyzerResults::One : AnalyzerResults::Zero, mSettings->mSWDIOChannel );
-			break;
-		case ACK2:
-			next_state = (command & 0x4) ? DATA : ACKTRN;
-			data_count = 0;
-			parity = false;
-			mResults->AddMarker( current_sample, (rise_bit) ? AnalyzerResults::One : AnalyzerResults::Zero, mSettings->mSWDIOChannel );
-
-			ack &= 0x3;
-			if (rise_bit)
-				ack |= 0x4;
-
-			frame.mData1 = ack & 0x7;
-			switch (ack & 0x7)
-			{
-			case 1: /* OK */
-			case 2: /* WAIT */
-				frame.mFlags = 0;
-				break;
-			case 4: /* FAULT */
-				frame.mFlags = DISPLAY_AS_WARNING_FLAG;
-				break;
-			default:
-				frame.mFlags = DISPLAY_AS_ERROR_FLAG;
-				break;
-			}
-
-			break;
-		case ACKTRN:
-			mResults->AddMarker( current_sample, AnalyzerResults::Square, mSettings->mSWDIOChannel );
-			next_state = DATA;
-			break;
-		case DATA:
-			data_count++;
-
-			if (33 == data_count)
-			{
-				next_state = (command & 0x4) ? ENDTRN : START;
-				mResults->AddMarker( current_sample, (parity == rise_bit) ? AnalyzerResults::Dot : AnalyzerResults::ErrorDot, mSettings->mSWDIOChannel );
-
-				frame.mData1 = (U32)command + ( (U32)ack << 4 );
-				frame.mData2 = data;
-				frame.mFlags = 0;
-				frame.mStartingSampleInclusive = onset_sample;
-				frame.mEndingSampleInclusive = current_sample;
-				mResults->AddFrame( frame );
-			}
-			else
-			{
-				data >>= 1;
-				if (rise_bit)
-					data |= 0x80000000;
-				parity ^= rise_bit;
-				next_state = DATA;
-				mResults->AddMarker( current_sample, (rise_bit) ? AnalyzerResults::One : AnalyzerResults::Zero, mSettings->mSWDIOChannel );
-			}
-			break;
-		case ENDTRN:
-			mResults->AddMarker( current_sample, AnalyzerResults::Square, mSettings->mSWDIOChannel );
-			next_state = START;
-			break;
-		case RST:
-			next_state = ( (ones_count >= 50) && !rise_bit) ? START : RST;
-			if (ones_count >= 50)
-				mResults->AddMarker( current_sample, AnalyzerResults::UpArrow, mSettings->mSWDIOChannel);
-			break;
-		default:
-			break; 		
-		}
-
-		if ( rise_bit )
-			ones_count++;
-		else
-			ones_count = 0;
-
-		state = next_state;
-
-		mResults->CommitResults();
-
-		ReportProgress( current_sample );
-
-		previous_current_sample = current_sample;
-
-		mSWCLK->AdvanceToNextEdge(); // falling edge
-	}
+		AnalyzerResults::Start,
+		AnalyzerResults::Stop,
+		AnalyzerResults::One,
+		AnalyzerResults::Zero,
+		AnalyzerResults::Dot,
+		AnalyzerResults::ErrorDot,
+		AnalyzerResults::Square,
+		AnalyzerResults::UpArrow,
+	};
+
+	mResults->AddMarker( sample_number, marker_types[marker], mSettings->mSWDIOChannel );
+}
+
+void SWDAnalyzer::AddFrame( const SWDFrame& swd_frame )
+{
+	Frame frame;
+
+	frame.mData1 = swd_frame.data1;
+	frame.mData2 = swd_frame.data2;
+	frame.mType = 0;
+	frame.mFlags = swd_frame.flags;
+	/* marginal timing, or a FAULT response */
+	if ( (swd_frame.flags & SWD_FLAG_MARGINAL_TIMING) || (0x4 == ((swd_frame.data1 >> 4) & 0x7)) )
+		frame.mFlags |= DISPLAY_AS_WARNING_FLAG;
+	frame.mStartingSampleInclusive = swd_frame.starting_sample;
+	frame.mEndingSampleInclusive = swd_frame.ending_sample;
+
+	mResults->AddFrame( frame );
 }
 
 bool SWDAnalyzer::NeedsRerun()
@@ -282,7 +168,9 @@ U32 SWDAnalyzer::GenerateSimulationData( U64 minimum_sample_index, U32 device_sa
 
 U32 SWDAnalyzer::GetMinimumSampleRateHz()
 {
-	return 0;
+	/* zero (no requirement) until a decode has measured the link */
+	std::lock_guard< std::mutex > lock( mLinkTimingMutex );
+	return mMinimumSafeSampleRate;
 }
 
 const char* SWDAnalyzer::GetAnalyzerName() const
@@ -2,11 +2,14 @@
 #define SWD_ANALYZER_H
 
 #include <Analyzer.h>
+#include <mutex>
 #include "SWDAnalyzerResults.h"
+#include "SWDDecoder.h"
+#include "SWDEdgeWalker.h"
 #include "SWDSimulationDataGenerator.h"
 
 class SWDAnalyzerSettings;
-class ANALYZER_EXPORT SWDAnalyzer : public Analyzer2
+class ANALYZER_EXPORT SWDAnalyzer : public Analyzer2, public SWDDecoderSink, public SWDEdgeWalkerHost
 {
 public:
 	SWDAnalyzer();
@@ -21,6 +24,22 @@ public:
 	virtual const char* GetAnalyzerName() const;
 	virtual bool NeedsRerun();
 
+	/*
+	    SWCLK/SWDIO timing over the decoded range so far.  The worker thread publishes a copy
+	    after every measured SWCLK period; this returns a consistent one from any thread.
+	*/
+	SWDLinkTiming GetLinkTiming() const;
+
+protected: //functions
+	/* SWDDecoderSink */
+	virtual void AddMarker( uint64_t sample_number, SWDMarker marker );
+	virtual void AddFrame( const SWDFrame& frame );
+
+	/* SWDEdgeWalkerHost */
+	virtual void CommitDecoded();
+	virtual void ReportDecodeProgress( uint64_t sample_number );
+	virtual void PublishLinkTiming( const SWDLinkTiming& timing );
+
 protected: //vars
 	std::auto_ptr< SWDAnalyzerSettings > mSettings;
 	std::auto_ptr< SWDAnalyzerResults > mResults;
@@ -29,6 +48,17 @@ protected: //vars
 
 	SWDSimulationDataGenerator mSimulationDataGenerator;
 	bool mSimulationInitialized;
+
+	/* as published by the worker thread, under mLinkTimingMutex */
+	mutable std::mutex mLinkTimingMutex;
+	SWDLinkTiming mLinkTiming;
+	U32 mMinimumSafeSampleRate;
+
+	/* decoder checkpoints survive reruns, so long as they were taken from the same capture */
+	SWDCheckpoints mCheckpoints;
+	Channel mCheckpointSWDIOChannel;
+	Channel mCheckpointSWCLKChannel;
+	U32 mCheckpointSampleRate;
 };
 
 extern "C" ANALYZER_EXPORT const char* __cdecl GetAnalyzerName();
@@ -32,6 +32,7 @@
 #include "SWDAnalyzerSettings.h"
 #include <iostream>
 #include <fstream>
+#include <string.h>
 
 SWDAnalyzerResults::SWDAnalyzerResults( SWDAnalyzer* analyzer, SWDAnalyzerSettings* settings )
 :	AnalyzerResults(),
@@ -96,6 +97,9 @@ static void build_string ( char *number_str, Frame *frame )
 		sprintf(number_str, "%s[%u=%s] ACK=%x", op_name, reg_addr, reg_name, ack_code);
 		break;
 	}
+
+	if (frame->mFlags & SWD_FLAG_MARGINAL_TIMING)
+		strcat(number_str, " (marginal timing)");
 }
 
 void SWDAnalyzerResults::GenerateBubbleText( U64 frame_index, Channel& channel, DisplayBase display_base )
@@ -114,6 +118,13 @@ void SWDAnalyzerResults::GenerateExportFile( const char* file, DisplayBase displ
 {
 	std::ofstream file_stream( file, std::ios::out );
 
+	if ( 1 == export_type_user_id )
+	{
+		GenerateTimingSummary( file_stream );
+		file_stream.close();
+		return;
+	}
+
 	U64 trigger_sample = mAnalyzer->GetTriggerSample();
 	U32 sample_rate = mAnalyzer->GetSampleRate();
 
@@ -142,6 +153,28 @@ void SWDAnalyzerResults::GenerateExportFile( const char* file, DisplayBase displ
 	file_stream.close();
 }
 
+void SWDAnalyzerResults::GenerateTimingSummary( std::ofstream& file_stream )
+{
+	SWDLinkTiming timing = mAnalyzer->GetLinkTiming();
+	double sample_rate = mAnalyzer->GetSampleRate();
+
+	if ( 0 == timing.clock_periods )
+	{
+		file_stream << "No SWCLK periods were measured" << std::endl;
+		return;
+	}
+
+	file_stream << "Sample rate [Hz]," << mAnalyzer->GetSampleRate() << std::endl;
+	file_stream << "SWCLK periods measured," << timing.clock_periods << std::endl;
+	file_stream << "SWCLK maximum frequency [Hz]," << sample_rate / timing.min_period << std::endl;
+	file_stream << "SWCLK average frequency [Hz]," << sample_rate * timing.clock_periods / timing.period_sum << std::endl;
+	file_stream << "SWCLK duty cycle [%]," << 100.0 * timing.high_sum / timing.period_sum << std::endl;
+	file_stream << "SWCLK shortest phase [samples]," << timing.min_phase << std::endl;
+	file_stream << "SWDIO minimum setup margin [samples]," << timing.min_setup << std::endl;
+	file_stream << "Frames with marginal timing," << timing.marginal_frames << std::endl;
+	file_stream << "Minimum safe sample rate [Hz]," << timing.MinimumSafeSampleRate( mAnalyzer->GetSampleRate() ) << std::endl;
+}
+
 void SWDAnalyzerResults::GenerateFrameTabularText( U64 frame_index, DisplayBase display_base )
 {
 	Frame frame = GetFrame( frame_index );
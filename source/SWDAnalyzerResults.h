@@ -2,6 +2,8 @@
 #define SWD_ANALYZER_RESULTS
 
 #include <AnalyzerResults.h>
+#include <fstream>
+#include "SWDDecoder.h"
 
 class SWDAnalyzer;
 class SWDAnalyzerSettings;
@@ -20,6 +22,7 @@ public:
 	virtual void GenerateTransactionTabularText( U64 transaction_id, DisplayBase display_base );
 
 protected: //functions
+	void GenerateTimingSummary( std::ofstream& file_stream );
 
 protected:  //vars
 	SWDAnalyzerSettings* mSettings;
@@ -28,10 +28,34 @@
 
 #include "SWDAnalyzerSettings.h"
 #include <AnalyzerHelpers.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static bool parse_sample( const char* text, U64* sample )
+{
+	char* end;
+
+	/* strtoull() would also take leading whitespace and a minus sign */
+	if ( (*text < '0') || (*text > '9') )
+		return false;
+
+	errno = 0;
+	*sample = strtoull( text, &end, 10 );
+
+	return (0 == errno) && (*end == '\0');
+}
+
+static void format_sample( char* text, U64 sample )
+{
+	sprintf( text, "%llu", (unsigned long long)sample );
+}
 
 SWDAnalyzerSettings::SWDAnalyzerSettings()
 :	mSWDIOChannel( UNDEFINED_CHANNEL ),
-	mSWCLKChannel( UNDEFINED_CHANNEL )
+	mSWCLKChannel( UNDEFINED_CHANNEL ),
+	mStartSample( 0 ),
+	mEndSample( 0 )
 {
 	mSWDIOChannelInterface.reset( new AnalyzerSettingInterfaceChannel() );
 	mSWDIOChannelInterface->SetTitleAndTooltip( "SWDIO", "SWDIO" );
@@ -41,13 +65,27 @@ SWDAnalyzerSettings::SWDAnalyzerSettings()
 	mSWCLKChannelInterface->SetTitleAndTooltip( "SWCLK", "SWCLK" );
 	mSWCLKChannelInterface->SetChannel( mSWCLKChannel );
 
+	mStartSampleInterface.reset( new AnalyzerSettingInterfaceText() );
+	mStartSampleInterface->SetTitleAndTooltip( "Decode from sample", "Only add frames and markers at or after this sample number" );
+	mStartSampleInterface->SetText( "0" );
+
+	mEndSampleInterface.reset( new AnalyzerSettingInterfaceText() );
+	mEndSampleInterface->SetTitleAndTooltip( "Decode to sample", "Stop decoding after this sample number (0 decodes to the end of the capture)" );
+	mEndSampleInterface->SetText( "0" );
+
 	AddInterface( mSWDIOChannelInterface.get() );
 	AddInterface( mSWCLKChannelInterface.get() );
+	AddInterface( mStartSampleInterface.get() );
+	AddInterface( mEndSampleInterface.get() );
 
 	AddExportOption( 0, "Export as text/csv file" );
 	AddExportExtension( 0, "text", "txt" );
 	AddExportExtension( 0, "csv", "csv" );
 
+	AddExportOption( 1, "Export link timing summary as text/csv file" );
+	AddExportExtension( 1, "text", "txt" );
+	AddExportExtension( 1, "csv", "csv" );
+
 	ClearChannels();
 	AddChannel( mSWDIOChannel, "SWDIO", false );
 	AddChannel( mSWCLKChannel, "SWCLK", false );
@@ -59,6 +97,22 @@ SWDAnalyzerSettings::~SWDAnalyzerSettings()
 
 bool SWDAnalyzerSettings::SetSettingsFromInterfaces()
 {
+	U64 start_sample, end_sample;
+
+	if ( !parse_sample( mStartSampleInterface->GetText(), &start_sample ) || !parse_sample( mEndSampleInterface->GetText(), &end_sample ) )
+	{
+		SetErrorText( "Sample numbers must be non-negative integers" );
+		return false;
+	}
+
+	if ( (0 != end_sample) && (end_sample < start_sample) )
+	{
+		SetErrorText( "Decode range ends before it starts" );
+		return false;
+	}
+
+	mStartSample = start_sample;
+	mEndSample = end_sample;
 	mSWDIOChannel = mSWDIOChannelInterface->GetChannel();
 	mSWCLKChannel = mSWCLKChannelInterface->GetChannel();
 
@@ -71,8 +125,15 @@ bool SWDAnalyzerSettings::SetSettingsFromInterfaces()
 
 void SWDAnalyzerSettings::UpdateInterfacesFromSettings()
 {
+	char text[32];
+
 	mSWDIOChannelInterface->SetChannel( mSWDIOChannel );
 	mSWCLKChannelInterface->SetChannel( mSWCLKChannel );
+
+	format_sample( text, mStartSample );
+	mStartSampleInterface->SetText( text );
+	format_sample( text, mEndSample );
+	mEndSampleInterface->SetText( text );
 }
 
 void SWDAnalyzerSettings::LoadSettings( const char* settings )
@@ -83,6 +144,13 @@ void SWDAnalyzerSettings::LoadSettings( const char* settings )
 	text_archive >> mSWDIOChannel;
 	text_archive >> mSWCLKChannel;
 
+	/* settings saved before the decode range existed decode the whole capture */
+	if ( !(text_archive >> mStartSample) || !(text_archive >> mEndSample) )
+	{
+		mStartSample = 0;
+		mEndSample = 0;
+	}
+
 	ClearChannels();
 	AddChannel( mSWDIOChannel, "SWDIO", true );
 	AddChannel( mSWCLKChannel, "SWCLK", true );
@@ -96,6 +164,8 @@ const char* SWDAnalyzerSettings::SaveSettings()
 
 	text_archive << mSWDIOChannel;
 	text_archive << mSWCLKChannel;
+	text_archive << mStartSample;
+	text_archive << mEndSample;
 
 	return SetReturnString( text_archive.GetString() );
 }
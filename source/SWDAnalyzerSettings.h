@@ -18,10 +18,14 @@ public:
 	
 	Channel mSWDIOChannel;
 	Channel mSWCLKChannel;
+	U64 mStartSample;
+	U64 mEndSample;
 
 protected:
 	std::auto_ptr< AnalyzerSettingInterfaceChannel >	mSWDIOChannelInterface;
 	std::auto_ptr< AnalyzerSettingInterfaceChannel >	mSWCLKChannelInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceText >		mStartSampleInterface;
+	std::auto_ptr< AnalyzerSettingInterfaceText >		mEndSampleInterface;
 };
 
 #endif //SWD_ANALYZER_SETTINGS
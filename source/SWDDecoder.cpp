@@ -0,0 +1,316 @@
+/*
+    The SW-DP protocol is described by the following publicly available documents:
+
+    DDI 0316 CoreSight™ DAP-Lite Technical Reference Manual
+    http://infocenter.arm.com/help/topic/com.arm.doc.ddi0316d/DDI0316D_dap_lite_trm.pdf
+
+    Programming Internal Flash Over the Serial Wire Debug Interface
+    http://www.silabs.com/Support%20Documents/TechnicalDocs/AN0062.pdf
+
+    CY8C41xx, CY8C42xx Programming Specifications
+    http://www.cypress.com/?docID=48133
+
+    SW-DP (Serial Wire Debug Port) Analyzer plugin for the Saleae Logic
+
+    Copyright (C) 2015 Peter Lawrence.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License version 2.1, as
+    published by the Free Software Foundation.  This program is
+    distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SWDDecoder.h"
+
+/* SWCLK stopped for longer than this is an idle gap, not a bit */
+static const uint64_t IDLE_PERIOD_SAMPLES = 10000;
+
+/*
+    a bit is only trusted if its SWDIO setup margin and both SWCLK phases each span this many
+    samples; it is both what marks a bit marginal and what the minimum safe sample rate aims for
+*/
+static const uint64_t MINIMUM_INTERVAL_SAMPLES = 2;
+
+void SWDLinkTiming::Reset()
+{
+	clock_periods = 0;
+	period_sum = 0;
+	high_sum = 0;
+	min_period = ~(uint64_t)0;
+	min_phase = ~(uint64_t)0;
+	min_setup = ~(uint64_t)0;
+	marginal_frames = 0;
+}
+
+uint32_t SWDLinkTiming::MinimumSafeSampleRate( uint32_t sample_rate ) const
+{
+	if ( 0 == clock_periods )
+		return 0;
+
+	/*
+	    both are at least one sample, as measured; the shortest of them is the one that must span
+	    MINIMUM_INTERVAL_SAMPLES, so a link without a marginal bit never asks for more than it was captured at
+	*/
+	uint64_t interval = (min_setup < min_phase) ? min_setup : min_phase;
+	uint64_t rate = ( (uint64_t)sample_rate * MINIMUM_INTERVAL_SAMPLES + interval - 1 ) / interval;
+
+	return (rate > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)rate;
+}
+
+SWDDecoder::SWDDecoder( SWDDecoderSink* sink )
+:	mSink( sink ),
+	mEmitFrom( 0 ),
+	mEmitTo( 0 ),
+	mEmitting( true )
+{
+	Reset();
+	mTiming.Reset();
+}
+
+void SWDDecoder::Reset()
+{
+	mState.state = RST;
+	mState.ones_count = 6;
+	mState.data_count = 0;
+	mState.parity = false;
+	mState.command = 0;
+	mState.ack = 0;
+	mState.data = 0;
+	mState.onset_sample = 0;
+	mState.previous_current_sample = 0;
+	mState.marginal = false;
+}
+
+void SWDDecoder::AddMarker( uint64_t sample_number, SWDMarker marker )
+{
+	if ( mEmitting )
+		mSink->AddMarker( sample_number, marker );
+}
+
+/* the transaction that began at onset_sample ended at 'ending_sample' */
+void SWDDecoder::AddFrame( uint64_t ending_sample, uint32_t data )
+{
+	SWDFrame frame;
+
+	if ( !mEmitting )
+		return;
+
+	frame.data1 = (uint32_t)mState.command + ( (uint32_t)mState.ack << 4 );
+	frame.data2 = data;
+	frame.flags = (mState.marginal) ? SWD_FLAG_MARGINAL_TIMING : 0;
+	frame.starting_sample = mState.onset_sample;
+	frame.ending_sample = ending_sample;
+
+	if ( mState.marginal )
+		mTiming.marginal_frames++;
+	mSink->AddFrame( frame );
+}
+
+/* returns whether the bit was sampled too close to an SWDIO transition, or on too short an SWCLK phase */
+bool SWDDecoder::MeasureBit( uint64_t current_sample, uint64_t falling_sample, uint64_t dio_edge_sample )
+{
+	uint64_t previous = mState.previous_current_sample;
+
+	if ( !previous || (falling_sample <= previous) || (falling_sample >= current_sample) )
+		return false;
+
+	uint64_t period = current_sample - previous;
+	uint64_t high = falling_sample - previous;
+	uint64_t low = current_sample - falling_sample;
+	uint64_t phase = (high < low) ? high : low;
+	uint64_t setup = current_sample - ( (dio_edge_sample > previous) ? dio_edge_sample : previous );
+
+	if ( period > IDLE_PERIOD_SAMPLES )
+		return false;
+
+	mTiming.clock_periods++;
+	mTiming.period_sum += period;
+	mTiming.high_sum += high;
+
+	if ( period < mTiming.min_period )
+		mTiming.min_period = period;
+	if ( phase < mTiming.min_phase )
+		mTiming.min_phase = phase;
+	if ( setup < mTiming.min_setup )
+		mTiming.min_setup = setup;
+
+	return (setup < MINIMUM_INTERVAL_SAMPLES) || (phase < MINIMUM_INTERVAL_SAMPLES);
+}
+
+void SWDDecoder::RisingEdge( uint64_t current_sample, bool rise_bit, uint64_t falling_sample, uint64_t dio_edge_sample )
+{
+	State& decoder = mState;
+	enum state_enum next_state = decoder.state;
+	bool marginal_bit = false;
+
+#if 1
+	/* method of jump-starting decoding if capture doesn't include 50 ones */
+	if ( (current_sample - decoder.previous_current_sample) > IDLE_PERIOD_SAMPLES )
+		decoder.state = START;
+#endif
+
+	/* a frame is delivered whole or not at all, so it is judged by where it started; at either end of the range */
+	uint64_t onset = ((RST == decoder.state) || (START == decoder.state)) ? current_sample : decoder.onset_sample;
+	mEmitting = (onset >= mEmitFrom) && ( !mEmitTo || (onset <= mEmitTo) );
+
+	/* only frame bits say anything about the link; idle clocking and turnarounds (where nobody drives SWDIO) don't */
+	switch (decoder.state)
+	{
+	case RST:
+	case TRN:
+	case ACKTRN:
+	case ENDTRN:
+		break;
+	case START:
+		if (!rise_bit)
+			break;
+		/* fall through */
+	default:
+		if ( mEmitting && falling_sample )
+			marginal_bit = MeasureBit( current_sample, falling_sample, dio_edge_sample );
+		break;
+	}
+
+	decoder.marginal |= marginal_bit;
+
+	switch (decoder.state)
+	{
+	case START:
+		next_state = (rise_bit) ? APnDP : START;
+		if (rise_bit)
+		{
+			AddMarker( current_sample, SWD_MARKER_START );
+			decoder.onset_sample = current_sample;	
+			decoder.marginal = marginal_bit;
+		}
+		break;
+	case APnDP:
+		decoder.parity = rise_bit;
+		next_state = RnW;
+		decoder.command &= 0x7;
+		if (rise_bit)
+			decoder.command |= 0x8;
+		AddMarker( current_sample, (rise_bit) ? SWD_MARKER_ONE : SWD_MARKER_ZERO );
+		break;
+	case RnW:
+		decoder.parity ^= rise_bit;
+		next_state = A0;
+		decoder.command &= 0xB;
+		if (rise_bit)
+			decoder.command |= 0x4;
+		AddMarker( current_sample, (rise_bit) ? SWD_MARKER_ONE : SWD_MARKER_ZERO );
+		break;
+	case A0:
+		decoder.parity ^= rise_bit;
+		next_state = A1;
+		decoder.command &= 0xE;
+		if (rise_bit)
+			decoder.command |= 0x1;
+		AddMarker( current_sample, (rise_bit) ? SWD_MARKER_ONE : SWD_MARKER_ZERO );
+		break;
+	case A1:
+		decoder.parity ^= rise_bit;
+		next_state = PARITY;
+		decoder.command &= 0xD;
+		if (rise_bit)
+			decoder.command |= 0x2;
+		AddMarker( current_sample, (rise_bit) ? SWD_MARKER_ONE : SWD_MARKER_ZERO );
+		break;
+	case PARITY:
+		next_state = (decoder.parity == rise_bit) ? STOP : RST;
+		AddMarker( current_sample, (decoder.parity == rise_bit) ? SWD_MARKER_DOT : SWD_MARKER_ERROR_DOT );
+		break;
+	case STOP:
+		next_state = (rise_bit) ? RST : PARK;
+		AddMarker( current_sample, (rise_bit) ? SWD_MARKER_ERROR_DOT : SWD_MARKER_STOP );
+		break;
+	case PARK:
+		next_state = (rise_bit) ? TRN : RST;
+		break;
+	case TRN:
+		AddMarker( current_sample, SWD_MARKER_SQUARE );
+		next_state = ACK0;
+		break;
+	case ACK0:
+		next_state = ACK1;
+		decoder.ack &= 0x6;
+		if (rise_bit)
+			decoder.ack |= 0x1;
+		AddMarker( current_sample, (rise_bit) ? SWD_MARKER_ONE : SWD_MARKER_ZERO );
+		break;
+	case ACK1:
+		next_state = ACK2;
+		decoder.ack &= 0x5;
+		if (rise_bit)
+			decoder.ack |= 0x2;
+		AddMarker( current_sample, (rise_bit) ? SWD_MARKER_ONE : SWD_MARKER_ZERO );
+		break;
+	case ACK2:
+		next_state = (decoder.command & 0x4) ? DATA : ACKTRN;
+		decoder.data_count = 0;
+		decoder.parity = false;
+		AddMarker( current_sample, (rise_bit) ? SWD_MARKER_ONE : SWD_MARKER_ZERO );
+
+		decoder.ack &= 0x3;
+		if (rise_bit)
+			decoder.ack |= 0x4;
+
+		/* WAIT and FAULT end the transaction after a turnaround, without a data phase (unless overrun detection is on) */
+		if ( (0x2 == decoder.ack) || (0x4 == decoder.ack) )
+		{
+			next_state = ENDTRN;
+			AddFrame( current_sample, 0 );
+		}
+
+		break;
+	case ACKTRN:
+		AddMarker( current_sample, SWD_MARKER_SQUARE );
+		next_state = DATA;
+		break;
+	case DATA:
+		decoder.data_count++;
+
+		if (33 == decoder.data_count)
+		{
+			next_state = (decoder.command & 0x4) ? ENDTRN : START;
+			AddMarker( current_sample, (decoder.parity == rise_bit) ? SWD_MARKER_DOT : SWD_MARKER_ERROR_DOT );
+			AddFrame( current_sample, decoder.data );
+		}
+		else
+		{
+			decoder.data >>= 1;
+			if (rise_bit)
+				decoder.data |= 0x80000000;
+			decoder.parity ^= rise_bit;
+			next_state = DATA;
+			AddMarker( current_sample, (rise_bit) ? SWD_MARKER_ONE : SWD_MARKER_ZERO );
+		}
+		break;
+	case ENDTRN:
+		AddMarker( current_sample, SWD_MARKER_SQUARE );
+		next_state = START;
+		break;
+	case RST:
+		next_state = ( (decoder.ones_count >= 50) && !rise_bit) ? START : RST;
+		if (decoder.ones_count >= 50)
+			AddMarker( current_sample, SWD_MARKER_UP_ARROW );
+		break;
+	default:
+		break; 		
+	}
+
+	if ( rise_bit )
+		decoder.ones_count++;
+	else
+		decoder.ones_count = 0;
+
+	decoder.state = next_state;
+
+	decoder.previous_current_sample = current_sample;
+}
@@ -0,0 +1,133 @@
+#ifndef SWD_DECODER
+#define SWD_DECODER
+
+/*
+    The SW-DP bit level state machine.  It doesn't depend on the Saleae SDK, so that
+    test/ can drive it from synthetic waveforms as well as SWDAnalyzer from a capture.
+*/
+
+#include <stdint.h>
+
+enum SWDMarker
+{
+	SWD_MARKER_START,
+	SWD_MARKER_STOP,
+	SWD_MARKER_ONE,
+	SWD_MARKER_ZERO,
+	SWD_MARKER_DOT,
+	SWD_MARKER_ERROR_DOT,
+	SWD_MARKER_SQUARE,
+	SWD_MARKER_UP_ARROW,
+};
+
+/* a bit of the frame was sampled too close to an SWDIO transition, or on too short an SWCLK phase, to be trusted */
+#define SWD_FLAG_MARGINAL_TIMING	( 1 << 0 )
+
+struct SWDFrame
+{
+	uint64_t starting_sample, ending_sample;
+	uint64_t data1;		/* command in bits 3..0, ACK in bits 6..4 */
+	uint64_t data2;		/* 32-bit data; 0 for WAIT and FAULT, which have no data phase */
+	uint8_t flags;
+};
+
+/* SWCLK/SWDIO timing of the frame bits decoded so far, in samples */
+struct SWDLinkTiming
+{
+	uint64_t clock_periods;
+	uint64_t period_sum, high_sum;
+	uint64_t min_period, min_phase, min_setup;
+	uint64_t marginal_frames;
+
+	void Reset();
+
+	/*
+	    lowest rate at which the shortest clock phase and setup margin seen would still not be marginal;
+	    never above 'sample_rate' unless some bit was.  0 if nothing was measured
+	*/
+	uint32_t MinimumSafeSampleRate( uint32_t sample_rate ) const;
+};
+
+/* where the decoder delivers its markers and frames */
+class SWDDecoderSink
+{
+public:
+	virtual ~SWDDecoderSink() {}
+
+	virtual void AddMarker( uint64_t sample_number, SWDMarker marker ) = 0;
+	virtual void AddFrame( const SWDFrame& frame ) = 0;
+};
+
+class SWDDecoder
+{
+public:
+	enum state_enum
+	{
+		START,
+		APnDP,
+		RnW,
+		A0,
+		A1,
+		PARITY,
+		STOP,
+		PARK,
+		TRN,
+		ACK0,
+		ACK1,
+		ACK2,
+		ACKTRN,
+		DATA,
+		RST,
+		ENDTRN,
+	};
+
+	/* everything the state machine carries from one rising SWCLK edge to the next */
+	struct State
+	{
+		enum state_enum state;
+		uint32_t ones_count, data_count;
+		bool parity;
+		uint8_t command, ack;
+		uint32_t data;
+		uint64_t onset_sample, previous_current_sample;
+		bool marginal;	/* a bit of the current frame was marginal, as SWD_FLAG_MARGINAL_TIMING */
+	};
+
+	SWDDecoder( SWDDecoderSink* sink );
+
+	void Reset();
+	const State& GetState() const { return mState; }
+	void SetState( const State& state ) { mState = state; }
+
+	/*
+	    markers and frames are only delivered for what starts within [from, to], 'to' zero for no end;
+	    a frame that starts inside is delivered whole, even where it carries on past 'to'
+	*/
+	void SetEmitRange( uint64_t from, uint64_t to ) { mEmitFrom = from; mEmitTo = to; }
+
+	/* part way through a transaction, rather than waiting for one to start */
+	bool InFrame() const { return (START != mState.state) && (RST != mState.state); }
+
+	const SWDLinkTiming& GetLinkTiming() const { return mTiming; }
+
+	/*
+	    SWDIO level 'bit' was sampled just before the SWCLK rising edge at 'sample_number'.
+	    'falling_sample' is the SWCLK falling edge since the previous rising edge, and
+	    'dio_edge_sample' the last SWDIO transition at or before the sample taken; with
+	    'falling_sample' zero, the bit's timing isn't measured.
+	*/
+	void RisingEdge( uint64_t sample_number, bool bit, uint64_t falling_sample, uint64_t dio_edge_sample );
+
+protected:
+	void AddMarker( uint64_t sample_number, SWDMarker marker );
+	void AddFrame( uint64_t ending_sample, uint32_t data );
+	bool MeasureBit( uint64_t sample_number, uint64_t falling_sample, uint64_t dio_edge_sample );
+
+	SWDDecoderSink* mSink;
+	State mState;
+	SWDLinkTiming mTiming;
+	uint64_t mEmitFrom, mEmitTo;
+	bool mEmitting;
+};
+
+#endif //SWD_DECODER
@@ -0,0 +1,310 @@
+#ifndef SWD_EDGE_WALKER
+#define SWD_EDGE_WALKER
+
+/*
+    Walks SWCLK and SWDIO edge by edge, feeding SWDDecoder, for SWDAnalyzer::WorkerThread() over
+    AnalyzerChannelData and for test/ over a mock of it.  ChannelData must provide the calls of
+    AnalyzerChannelData used below, and swd_is_high( ChannelData* ) its current level.
+*/
+
+#include <stddef.h>
+#include <vector>
+#include "SWDDecoder.h"
+
+/* rising SWCLK edges between decoder checkpoints */
+static const uint64_t SWD_CHECKPOINT_INTERVAL = 65536;
+
+/* rising SWCLK edges (sample number and SWDIO level) that identify a capture, hashed FNV-1a style */
+static const uint64_t SWD_FINGERPRINT_EDGES = 256;
+static const uint64_t SWD_FINGERPRINT_BASIS = 0xcbf29ce484222325ULL;
+static const uint64_t SWD_FINGERPRINT_PRIME = 0x100000001b3ULL;
+
+/* rising SWCLK edges leading up to a checkpoint that must match, the same way, before it is restored */
+static const uint64_t SWD_CHECKPOINT_WINDOW = 256;
+
+inline uint64_t swd_fingerprint( uint64_t fingerprint, uint64_t sample_number, bool level )
+{
+	fingerprint = (fingerprint ^ sample_number) * SWD_FINGERPRINT_PRIME;
+	return (fingerprint ^ (uint64_t)level) * SWD_FINGERPRINT_PRIME;
+}
+
+struct SWDCheckpoint
+{
+	uint64_t sample;	/* rising SWCLK edge that the state applies to */
+	uint64_t rising_count;
+	uint64_t window;	/* fingerprint of the SWD_CHECKPOINT_WINDOW rising edges before it */
+	bool swdio_level;	/* as sampled for that edge */
+	SWDDecoder::State decoder;
+};
+
+/* decoder checkpoints outlive a run, so that the next one over the same capture can skip ahead */
+struct SWDCheckpoints
+{
+	SWDCheckpoints() : fingerprint( 0 ) {}
+
+	void Clear()
+	{
+		list.clear();
+		fingerprint = 0;
+	}
+
+	std::vector< SWDCheckpoint > list;
+	uint64_t fingerprint;	/* of the capture they were taken from */
+};
+
+/* what the edge walker reports back, besides the decoder's markers and frames */
+class SWDEdgeWalkerHost
+{
+public:
+	virtual ~SWDEdgeWalkerHost() {}
+
+	/* markers and frames so far are final */
+	virtual void CommitDecoded() = 0;
+	virtual void ReportDecodeProgress( uint64_t sample_number ) = 0;
+
+	/* after every SWCLK period the decoder measures */
+	virtual void PublishLinkTiming( const SWDLinkTiming& timing ) = 0;
+};
+
+template< class ChannelData >
+class SWDEdgeWalker
+{
+public:
+	SWDEdgeWalker( ChannelData* swclk, ChannelData* swdio, SWDDecoder* decoder, SWDEdgeWalkerHost* host, SWDCheckpoints* checkpoints );
+
+	/* 'end_sample' zero for to the end of the capture; as in SWDDecoder::SetEmitRange() */
+	void SetRange( uint64_t start_sample, uint64_t end_sample );
+
+	/* must exceed SWD_FINGERPRINT_EDGES + SWD_CHECKPOINT_WINDOW */
+	void SetCheckpointInterval( uint64_t rising_edges ) { mCheckpointInterval = rising_edges; }
+
+	/* the checkpoint the last Run() skipped ahead to, by rising SWCLK edge; zero if it didn't */
+	uint64_t GetResumedAt() const { return mResumedAt; }
+
+	/* like WorkerThread(), doesn't return; it ends when the channel data does */
+	void Run();
+
+protected:
+	bool ResumeFromCheckpoint( uint64_t fingerprint, uint64_t& rising_count );
+
+	ChannelData* mSWCLK;
+	ChannelData* mSWDIO;
+	SWDDecoder* mDecoder;
+	SWDEdgeWalkerHost* mHost;
+	SWDCheckpoints* mCheckpoints;
+
+	uint64_t mStartSample, mEndSample;
+	uint64_t mCheckpointInterval;
+	uint64_t mResumedAt;
+};
+
+template< class ChannelData >
+SWDEdgeWalker< ChannelData >::SWDEdgeWalker( ChannelData* swclk, ChannelData* swdio, SWDDecoder* decoder, SWDEdgeWalkerHost* host, SWDCheckpoints* checkpoints )
+:	mSWCLK( swclk ),
+	mSWDIO( swdio ),
+	mDecoder( decoder ),
+	mHost( host ),
+	mCheckpoints( checkpoints ),
+	mStartSample( 0 ),
+	mEndSample( 0 ),
+	mCheckpointInterval( SWD_CHECKPOINT_INTERVAL ),
+	mResumedAt( 0 )
+{
+}
+
+template< class ChannelData >
+void SWDEdgeWalker< ChannelData >::SetRange( uint64_t start_sample, uint64_t end_sample )
+{
+	mStartSample = start_sample;
+	mEndSample = end_sample;
+	mDecoder->SetEmitRange( start_sample, end_sample );
+}
+
+template< class ChannelData >
+void SWDEdgeWalker< ChannelData >::Run()
+{
+	uint64_t current_sample, rising_count, previous_rising, falling, dio_edge, published_periods, window;
+	bool rise_bit, in_range;
+
+	if( swd_is_high( mSWCLK ) )
+		mSWCLK->AdvanceToNextEdge();
+
+	rising_count = 0;
+	mResumedAt = 0;
+
+	/* nothing is checkpointed until this run has confirmed which capture it is decoding */
+	bool record_checkpoints = false;
+	uint64_t fingerprint = SWD_FINGERPRINT_BASIS;
+	window = SWD_FINGERPRINT_BASIS;
+
+	/* no timing is measured until a full SWCLK period has been seen inside the range */
+	previous_rising = 0;
+	falling = 0;
+	dio_edge = 0;
+	published_periods = 0;
+
+	for( ; ; )
+	{
+		if ( SWD_FINGERPRINT_EDGES == rising_count )
+		{
+			uint64_t position = mSWCLK->GetSampleNumber();
+
+			record_checkpoints = ResumeFromCheckpoint( fingerprint, rising_count );
+
+			/* no SWCLK period spans a skip */
+			if ( mSWCLK->GetSampleNumber() != position )
+				previous_rising = 0;
+		}
+
+		mSWCLK->AdvanceToNextEdge(); // rising edge
+		current_sample = mSWCLK->GetSampleNumber();
+
+		if ( (0 != mEndSample) && (current_sample > mEndSample) && !mDecoder->InFrame() )
+		{
+			/*
+			    past the range, and the last frame that started inside it is finished, so stop decoding;
+			    but follow SWCLK to the end of the capture for the sake of progress
+			*/
+			mHost->ReportDecodeProgress( current_sample );
+			mSWCLK->AdvanceToNextEdge(); // falling edge
+			continue;
+		}
+
+		in_range = current_sample >= mStartSample;
+
+		if ( in_range && previous_rising )
+		{
+			/* note the last SWDIO transition the sample below will see, to judge setup margin */
+			while ( mSWDIO->WouldAdvancingToAbsPositionCauseTransition( current_sample - 1 ) )
+			{
+				mSWDIO->AdvanceToNextEdge();
+				dio_edge = mSWDIO->GetSampleNumber();
+			}
+		}
+
+		mSWDIO->AdvanceToAbsPosition( current_sample - 1 );
+		rise_bit = swd_is_high( mSWDIO );
+
+		if ( rising_count < SWD_FINGERPRINT_EDGES )
+			fingerprint = swd_fingerprint( fingerprint, current_sample, rise_bit );
+
+		if ( record_checkpoints && (0 == (rising_count % mCheckpointInterval)) &&
+		     (mCheckpoints->list.empty() || (current_sample > mCheckpoints->list.back().sample)) )
+		{
+			SWDCheckpoint checkpoint;
+
+			checkpoint.sample = current_sample;
+			checkpoint.rising_count = rising_count;
+			checkpoint.window = window;
+			checkpoint.swdio_level = rise_bit;
+			checkpoint.decoder = mDecoder->GetState();
+			mCheckpoints->list.push_back( checkpoint );
+		}
+
+		/* the window leading up to the next checkpoint */
+		if ( (mCheckpointInterval - SWD_CHECKPOINT_WINDOW) == (rising_count % mCheckpointInterval) )
+			window = SWD_FINGERPRINT_BASIS;
+		window = swd_fingerprint( window, current_sample, rise_bit );
+
+		mDecoder->RisingEdge( current_sample, rise_bit, (previous_rising) ? falling : 0, dio_edge );
+
+		rising_count++;
+
+		if ( in_range )
+			mHost->CommitDecoded();
+
+		if ( mDecoder->GetLinkTiming().clock_periods != published_periods )
+		{
+			published_periods = mDecoder->GetLinkTiming().clock_periods;
+			mHost->PublishLinkTiming( mDecoder->GetLinkTiming() );
+		}
+
+		mHost->ReportDecodeProgress( current_sample );
+
+		previous_rising = (in_range) ? current_sample : 0;
+
+		mSWCLK->AdvanceToNextEdge(); // falling edge
+		falling = mSWCLK->GetSampleNumber();
+	}
+}
+
+/*
+    Called with SWCLK low once the first SWD_FINGERPRINT_EDGES rising edges have been decoded.  If the
+    checkpoints are from this capture, skips ahead to the nearest one before the range.  Returns
+    whether checkpoints may be recorded for the rest of the run.
+
+    SWCLK is followed edge by edge rather than sought, since seeking past the end of the data
+    would wait for more that never comes.  Only the window leading up to the checkpoint samples
+    SWDIO, and the decoder state is restored only if the window matches; the edges before it are
+    not decoded though, so if it doesn't, all that's left is to resynchronise.
+*/
+template< class ChannelData >
+bool SWDEdgeWalker< ChannelData >::ResumeFromCheckpoint( uint64_t fingerprint, uint64_t& rising_count )
+{
+	std::vector< SWDCheckpoint >& list = mCheckpoints->list;
+	const SWDCheckpoint* checkpoint = 0;
+
+	if ( mCheckpoints->fingerprint != fingerprint )
+	{
+		list.clear();
+		mCheckpoints->fingerprint = fingerprint;
+		return true;
+	}
+
+	/* the last one before the range whose window is still ahead */
+	for ( size_t i = 0; i < list.size(); i++ )
+	{
+		if ( (list[i].sample <= mStartSample) && (list[i].rising_count >= rising_count + SWD_CHECKPOINT_WINDOW) )
+			checkpoint = &list[i];
+	}
+
+	if ( !checkpoint )
+		return true;
+
+	uint64_t window = SWD_FINGERPRINT_BASIS;
+	uint64_t sample_number;
+
+	while ( (rising_count < checkpoint->rising_count) && mSWCLK->DoMoreTransitionsExistInCurrentData() )
+	{
+		mSWCLK->AdvanceToNextEdge(); // rising edge
+		sample_number = mSWCLK->GetSampleNumber();
+
+		if ( rising_count >= checkpoint->rising_count - SWD_CHECKPOINT_WINDOW )
+		{
+			mSWDIO->AdvanceToAbsPosition( sample_number - 1 );
+			window = swd_fingerprint( window, sample_number, swd_is_high( mSWDIO ) );
+		}
+
+		rising_count++;
+		mHost->ReportDecodeProgress( sample_number );
+
+		if ( !mSWCLK->DoMoreTransitionsExistInCurrentData() )
+			break;
+		mSWCLK->AdvanceToNextEdge(); // falling edge
+	}
+
+	if ( (rising_count == checkpoint->rising_count) && (window == checkpoint->window) && !swd_is_high( mSWCLK ) &&
+	     mSWCLK->DoMoreTransitionsExistInCurrentData() && (mSWCLK->GetSampleOfNextEdge() == checkpoint->sample) )
+	{
+		mSWDIO->AdvanceToAbsPosition( checkpoint->sample - 1 );
+
+		if ( swd_is_high( mSWDIO ) == checkpoint->swdio_level )
+		{
+			mDecoder->SetState( checkpoint->decoder );
+			mResumedAt = rising_count;
+			return true;
+		}
+	}
+
+	/* not the capture the checkpoints came from after all */
+	mCheckpoints->Clear();
+	mDecoder->Reset();
+
+	/* the data ran out part way through a period; the walk carries on from the next rising edge */
+	if ( swd_is_high( mSWCLK ) )
+		mSWCLK->AdvanceToNextEdge();
+
+	return false;
+}
+
+#endif //SWD_EDGE_WALKER
@@ -0,0 +1,959 @@
+/*
+    Regression and benchmark harness for the SW-DP decoder state machine.
+
+    Synthetic SWCLK/SWDIO waveforms are played through a mock of the Saleae channel
+    data interface and walked by the same SWDEdgeWalker that SWDAnalyzer::WorkerThread()
+    walks a capture with.  The markers and frames that come out are compared against
+    test/golden/.
+
+    usage: swd_decoder_test <golden directory> [--update] [--bench [scale]]
+
+    Copyright (C) 2015 Peter Lawrence.  All rights reserved.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License version 2.1, as
+    published by the Free Software Foundation.  This program is
+    distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or
+    FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../source/SWDDecoder.h"
+#include "../source/SWDEdgeWalker.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <new>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/* heap in use and its high-water mark, for the benchmark; every block carries its size in front of it */
+static size_t heap_in_use = 0, heap_peak = 0;
+static const size_t HEAP_HEADER = 16;
+
+void* operator new( size_t size )
+{
+	char* block = (char*)malloc( HEAP_HEADER + size );
+
+	if ( !block )
+		throw std::bad_alloc();
+
+	*(size_t*)block = size;
+	heap_in_use += size;
+	if ( heap_in_use > heap_peak )
+		heap_peak = heap_in_use;
+
+	return block + HEAP_HEADER;
+}
+
+void operator delete( void* pointer ) throw()
+{
+	if ( !pointer )
+		return;
+
+	char* block = (char*)pointer - HEAP_HEADER;
+
+	heap_in_use -= *(size_t*)block;
+	free( block );
+}
+
+/* thrown where AnalyzerChannelData would wait for more of the capture, which is how a walk ends */
+struct EndOfCapture {};
+
+/* thrown where AnalyzerChannelData would wait for data past the end of the capture, which is never fine */
+struct SeekPastEnd {};
+
+/* transitions of one channel, standing in for AnalyzerChannelData */
+class MockChannelData
+{
+public:
+	MockChannelData() : mInitial( false ), mLevel( false ), mIndex( 0 ), mSample( 0 ), mLength( ~(uint64_t)0 ) {}
+
+	/* building the waveform */
+	void SetLevel( uint64_t sample_number, bool level )
+	{
+		bool last = (mTransitions.size() & 1) ? !mInitial : mInitial;
+		if ( level != last )
+			mTransitions.push_back( sample_number );
+	}
+
+	/* cropping the waveform, as though the capture started at 'sample_number' */
+	void Crop( uint64_t sample_number )
+	{
+		std::vector< uint64_t > kept;
+		bool level = mInitial;
+
+		for ( size_t i = 0; i < mTransitions.size(); i++ )
+		{
+			if ( mTransitions[i] <= sample_number )
+				level = !level;
+			else
+				kept.push_back( mTransitions[i] - sample_number );
+		}
+
+		mInitial = level;
+		mTransitions.swap( kept );
+	}
+
+	/* ending the waveform, as though the capture stopped at 'sample_number' */
+	void Truncate( uint64_t sample_number )
+	{
+		while ( !mTransitions.empty() && (mTransitions.back() >= sample_number) )
+			mTransitions.pop_back();
+	}
+
+	void SetLength( uint64_t samples ) { mLength = samples; }
+
+	void Rewind()
+	{
+		mLevel = mInitial;
+		mIndex = 0;
+		mSample = 0;
+	}
+
+	size_t GetTransitionCount() const { return mTransitions.size(); }
+
+	/* the part of the AnalyzerChannelData interface that SWDEdgeWalker uses */
+	uint64_t GetSampleNumber() const { return mSample; }
+	bool GetBitState() const { return mLevel; }
+	bool HasNextEdge() const { return mIndex < mTransitions.size(); }
+	bool DoMoreTransitionsExistInCurrentData() const { return HasNextEdge(); }
+
+	void AdvanceToNextEdge()
+	{
+		if ( !HasNextEdge() )
+			throw EndOfCapture();
+		mSample = mTransitions[mIndex++];
+		mLevel = !mLevel;
+	}
+
+	void AdvanceToAbsPosition( uint64_t sample_number )
+	{
+		if ( sample_number >= mLength )
+			throw SeekPastEnd();
+		while ( (mIndex < mTransitions.size()) && (mTransitions[mIndex] <= sample_number) )
+		{
+			mIndex++;
+			mLevel = !mLevel;
+		}
+		mSample = sample_number;
+	}
+
+	bool WouldAdvancingToAbsPositionCauseTransition( uint64_t sample_number ) const
+	{
+		if ( sample_number >= mLength )
+			throw SeekPastEnd();
+		return (mIndex < mTransitions.size()) && (mTransitions[mIndex] <= sample_number);
+	}
+
+	uint64_t GetSampleOfNextEdge() const
+	{
+		if ( !HasNextEdge() )
+			throw EndOfCapture();
+		return mTransitions[mIndex];
+	}
+
+protected:
+	std::vector< uint64_t > mTransitions;
+	bool mInitial, mLevel;
+	size_t mIndex;
+	uint64_t mSample, mLength;
+};
+
+inline bool swd_is_high( MockChannelData* channel )
+{
+	return channel->GetBitState();
+}
+
+/* deterministic on every platform, unlike rand() */
+class Random
+{
+public:
+	Random( uint32_t seed ) : mState( seed ) {}
+
+	uint32_t Next()
+	{
+		mState ^= mState << 13;
+		mState ^= mState >> 17;
+		mState ^= mState << 5;
+		return mState;
+	}
+
+	bool Chance( uint32_t one_in ) { return 0 == (Next() % one_in); }
+
+protected:
+	uint32_t mState;
+};
+
+/* builds an SWD waveform; the host drives SWDIO on falling SWCLK edges, the target just after rising ones */
+class Waveform
+{
+public:
+	enum { OK = 1, WAIT = 2, FAULT = 4 };
+
+	Waveform( uint64_t half_period ) : target_delay( 1 ), mHalfPeriod( half_period ), mNow( 1 ) {}
+
+	MockChannelData swclk, swdio;
+
+	/* samples after the rising SWCLK edge before the target's next bit appears on SWDIO */
+	uint64_t target_delay;
+
+	void HostBit( bool bit )
+	{
+		SetDIO( mNow, bit );
+		Clock();
+	}
+
+	void TargetBit( bool bit )
+	{
+		SetDIO( mNow - mHalfPeriod + target_delay, bit );
+		Clock();
+	}
+
+	/* nobody drives SWDIO; the pull-up takes it high */
+	void Turnaround()
+	{
+		SetDIO( mNow, true );
+		Clock();
+	}
+
+	void Idle( unsigned cycles )
+	{
+		while ( cycles-- )
+			HostBit( false );
+	}
+
+	/* SWCLK stopped low */
+	void Gap( uint64_t samples ) { mNow += samples; }
+
+	void LineReset()
+	{
+		for ( unsigned i = 0; i < 56; i++ )
+			HostBit( true );
+		Idle( 2 );
+	}
+
+	void Transaction( bool APnDP, bool RnW, unsigned addr, unsigned ack, uint32_t data, bool request_parity_ok = true, bool data_parity_ok = true )
+	{
+		bool parity = APnDP ^ RnW ^ (addr & 1) ^ ((addr >> 1) & 1);
+
+		HostBit( true );
+		HostBit( APnDP );
+		HostBit( RnW );
+		HostBit( addr & 1 );
+		HostBit( (addr >> 1) & 1 );
+		HostBit( request_parity_ok ? parity : !parity );
+		HostBit( false );
+		HostBit( true );
+		Turnaround();
+
+		for ( unsigned i = 0; i < 3; i++ )
+			TargetBit( (ack >> i) & 1 );
+
+		if ( OK != ack )
+		{
+			Turnaround();
+			Idle( 2 );
+			return;
+		}
+
+		parity = false;
+
+		if ( RnW )
+		{
+			for ( unsigned i = 0; i < 32; i++ )
+			{
+				TargetBit( (data >> i) & 1 );
+				parity ^= (data >> i) & 1;
+			}
+			TargetBit( data_parity_ok ? parity : !parity );
+			Turnaround();
+		}
+		else
+		{
+			Turnaround();
+			for ( unsigned i = 0; i < 32; i++ )
+			{
+				HostBit( (data >> i) & 1 );
+				parity ^= (data >> i) & 1;
+			}
+			HostBit( data_parity_ok ? parity : !parity );
+		}
+
+		Idle( 2 );
+	}
+
+	void Crop( uint64_t sample_number )
+	{
+		swclk.Crop( sample_number );
+		swdio.Crop( sample_number );
+		mNow -= sample_number;
+	}
+
+	void Truncate( uint64_t sample_number )
+	{
+		swclk.Truncate( sample_number );
+		swdio.Truncate( sample_number );
+		mNow = sample_number;
+	}
+
+	uint64_t Now() const { return mNow; }
+
+protected:
+	void SetDIO( uint64_t sample_number, bool level )
+	{
+		swdio.SetLevel( sample_number, level );
+	}
+
+	void Clock()
+	{
+		swclk.SetLevel( mNow + mHalfPeriod, true );
+		swclk.SetLevel( mNow + 2 * mHalfPeriod, false );
+		mNow += 2 * mHalfPeriod;
+	}
+
+	uint64_t mHalfPeriod, mNow;
+};
+
+/* markers and frames as text, one per line */
+class TextSink : public SWDDecoderSink
+{
+public:
+	virtual void AddMarker( uint64_t sample_number, SWDMarker marker )
+	{
+		static const char* names[] = { "Start", "Stop", "One", "Zero", "Dot", "ErrorDot", "Square", "UpArrow" };
+		char line[64];
+
+		sprintf( line, "M %llu %s\n", (unsigned long long)sample_number, names[marker] );
+		text += line;
+	}
+
+	virtual void AddFrame( const SWDFrame& frame )
+	{
+		char line[128];
+
+		sprintf( line, "F %llu %llu %02llx %08llx %02x\n", (unsigned long long)frame.starting_sample, (unsigned long long)frame.ending_sample,
+			(unsigned long long)frame.data1, (unsigned long long)frame.data2, frame.flags );
+		text += line;
+	}
+
+	std::string text;
+};
+
+/* for benchmarking, where formatting text would swamp the decoder */
+class CountingSink : public SWDDecoderSink
+{
+public:
+	CountingSink() : markers( 0 ), frames( 0 ) {}
+
+	virtual void AddMarker( uint64_t sample_number, SWDMarker marker ) { markers++; }
+	virtual void AddFrame( const SWDFrame& frame ) { frames++; }
+
+	uint64_t markers, frames;
+};
+
+/* takes what SWDEdgeWalker reports back to SWDAnalyzer */
+class TestHost : public SWDEdgeWalkerHost
+{
+public:
+	TestHost() : rising_edges( 0 ), progress( 0 ) { timing.Reset(); }
+
+	virtual void CommitDecoded() {}
+
+	/* once for every rising SWCLK edge, decoded or not */
+	virtual void ReportDecodeProgress( uint64_t sample_number )
+	{
+		rising_edges++;
+		progress = sample_number;
+	}
+
+	virtual void PublishLinkTiming( const SWDLinkTiming& published ) { timing = published; }
+
+	uint64_t rising_edges, progress;
+	SWDLinkTiming timing;
+};
+
+/* rising SWCLK edges between checkpoints, scaled down to suit the workloads */
+static const uint64_t TEST_CHECKPOINT_INTERVAL = 1024;
+
+/* walks the waveform as SWDAnalyzer::WorkerThread() walks a capture; returns the checkpoint resumed from, if any */
+static uint64_t decode( Waveform& waveform, SWDDecoder& decoder, TestHost& host, uint64_t start_sample = 0, uint64_t end_sample = 0,
+	SWDCheckpoints* checkpoints = 0, uint64_t checkpoint_interval = TEST_CHECKPOINT_INTERVAL )
+{
+	SWDCheckpoints unused;
+	SWDEdgeWalker< MockChannelData > walker( &waveform.swclk, &waveform.swdio, &decoder, &host, (checkpoints) ? checkpoints : &unused );
+
+	waveform.swclk.Rewind();
+	waveform.swdio.Rewind();
+	waveform.swclk.SetLength( waveform.Now() );
+	waveform.swdio.SetLength( waveform.Now() );
+
+	walker.SetRange( start_sample, end_sample );
+	walker.SetCheckpointInterval( checkpoint_interval );
+
+	try
+	{
+		walker.Run();
+	}
+	catch ( EndOfCapture& )
+	{
+	}
+
+	return walker.GetResumedAt();
+}
+
+/* the workloads; 'scale' repeats the body of each for benchmarking */
+
+static void idle_heavy( Waveform& w, unsigned scale )
+{
+	w.LineReset();
+	for ( unsigned i = 0; i < 8 * scale; i++ )
+	{
+		w.Idle( 200 );
+		w.Transaction( false, true, 0, Waveform::OK, 0x2BA01477 );	/* ReadDP IDCODE */
+		w.Gap( 50000 );
+	}
+}
+
+static void wait_storm( Waveform& w, unsigned scale )
+{
+	w.LineReset();
+	for ( unsigned i = 0; i < scale; i++ )
+	{
+		for ( unsigned j = 0; j < 30; j++ )
+			w.Transaction( true, true, 3, Waveform::WAIT, 0 );		/* ReadAP DRW */
+		w.Transaction( true, true, 3, Waveform::OK, 0xCAFEF00D + i );
+		for ( unsigned j = 0; j < 10; j++ )
+			w.Transaction( true, false, 3, Waveform::WAIT, 0 );		/* WriteAP DRW */
+		w.Transaction( true, false, 3, Waveform::OK, 0xBEEF0000 + i );
+		w.Transaction( true, true, 3, Waveform::FAULT, 0 );
+		w.Transaction( false, false, 0, Waveform::OK, 0x1E );			/* WriteDP ABORT, clearing the sticky flags */
+	}
+}
+
+/* 'late_change' alters the second half of the writes, for a capture that only differs part way through */
+static void drw_burst_changed( Waveform& w, unsigned scale, uint32_t late_change )
+{
+	w.LineReset();
+	for ( unsigned i = 0; i < scale; i++ )
+	{
+		w.Transaction( true, false, 1, Waveform::OK, 0x20000000 );		/* WriteAP TAR */
+		for ( unsigned j = 0; j < 32; j++ )
+			w.Transaction( true, false, 3, Waveform::OK, (0x01010101 * j) ^ ((j < 16) ? 0 : late_change) );	/* WriteAP DRW */
+		w.Transaction( true, false, 1, Waveform::OK, 0x20000000 );
+		for ( unsigned j = 0; j < 32; j++ )
+			w.Transaction( true, true, 3, Waveform::OK, 0x01010101 * j );	/* ReadAP DRW */
+		w.Transaction( false, true, 3, Waveform::OK, 0x1F1F1F1F );		/* ReadDP RDBUFF */
+	}
+}
+
+static void drw_burst( Waveform& w, unsigned scale )
+{
+	drw_burst_changed( w, scale, 0 );
+}
+
+static void parity_noise( Waveform& w, unsigned scale )
+{
+	Random random( 0x5eed );
+
+	w.LineReset();
+	for ( unsigned i = 0; i < 40 * scale; i++ )
+	{
+		bool APnDP = random.Chance( 2 );
+		bool RnW = random.Chance( 2 );
+		bool request_ok = !random.Chance( 5 );
+
+		w.Transaction( APnDP, RnW, random.Next() & 3, Waveform::OK, random.Next(), request_ok, !random.Chance( 5 ) );
+
+		/* after a request parity error the target stays silent, so the host resets the line */
+		if ( !request_ok )
+			w.LineReset();
+	}
+}
+
+static void mid_stream_start( Waveform& w, unsigned scale )
+{
+	w.LineReset();
+	for ( unsigned i = 0; i < scale; i++ )
+	{
+		for ( unsigned j = 0; j < 8; j++ )
+			w.Transaction( true, true, 3, Waveform::OK, 0xA5A50000 + j );
+		w.Gap( 20000 );
+		for ( unsigned j = 0; j < 8; j++ )
+			w.Transaction( true, false, 3, Waveform::OK, 0x5A5A0000 + j );
+	}
+
+	/* the capture starts part way through the fourth transaction */
+	w.Crop( 56 * 8 + 3 * 47 * 8 + 20 * 8 + 3 );
+}
+
+static void target_timing( Waveform& w, unsigned scale )
+{
+	w.LineReset();
+	for ( unsigned i = 0; i < scale; i++ )
+	{
+		/* SWDIO changing on the very sample SWCLK rises is after the bit was sampled; these are fine */
+		w.target_delay = 0;
+		for ( unsigned j = 0; j < 4; j++ )
+			w.Transaction( true, true, 3, Waveform::OK, 0x12345678 + j );
+
+		/* but changing one sample before it leaves too little setup margin; these get flagged */
+		w.target_delay = 7;
+		for ( unsigned j = 0; j < 4; j++ )
+			w.Transaction( true, true, 3, Waveform::OK, 0x87654321 + j );
+		w.target_delay = 1;
+	}
+}
+
+static void rate_boundary( Waveform& w, unsigned scale )
+{
+	/* every phase and every setup margin exactly as short as can be trusted, and not one sample shorter */
+	w.target_delay = 2;
+	w.LineReset();
+	for ( unsigned i = 0; i < scale; i++ )
+	{
+		for ( unsigned j = 0; j < 4; j++ )
+			w.Transaction( true, true, 3, Waveform::OK, 0x0F0F0F0F << j );
+		for ( unsigned j = 0; j < 4; j++ )
+			w.Transaction( true, false, 3, Waveform::OK, 0xF0F0F0F0 >> j );
+	}
+}
+
+struct Workload
+{
+	const char* name;
+	void (*build)( Waveform& w, unsigned scale );
+	uint64_t half_period;
+};
+
+static const Workload workloads[] =
+{
+	{ "idle",         idle_heavy,       4 },
+	{ "wait_storm",   wait_storm,       4 },
+	{ "drw_burst",    drw_burst,        2 },
+	{ "parity_noise", parity_noise,     4 },
+	{ "mid_stream",   mid_stream_start, 4 },
+	{ "target_timing", target_timing,   4 },
+	{ "rate_boundary", rate_boundary,   2 },
+};
+
+static const unsigned num_workloads = sizeof( workloads ) / sizeof( workloads[0] );
+
+/* the link timing is judged against a capture at this nominal rate */
+static const uint32_t NOMINAL_SAMPLE_RATE = 100000000;
+
+static std::string run_workload( const Workload& workload, SWDLinkTiming* measured = 0 )
+{
+	Waveform waveform( workload.half_period );
+	TextSink sink;
+	SWDDecoder decoder( &sink );
+	TestHost host;
+
+	workload.build( waveform, 1 );
+	decode( waveform, decoder, host );
+
+	/* the link timing as published, and what it asks of a capture at a nominal 100 MHz */
+	const SWDLinkTiming& timing = host.timing;
+	char line[256];
+
+	if ( measured )
+		*measured = timing;
+
+	sprintf( line, "T periods=%llu period_sum=%llu high_sum=%llu min_period=%llu min_phase=%llu min_setup=%llu marginal_frames=%llu minimum_rate@100MHz=%u\n",
+		(unsigned long long)timing.clock_periods, (unsigned long long)timing.period_sum, (unsigned long long)timing.high_sum,
+		(unsigned long long)timing.min_period, (unsigned long long)timing.min_phase, (unsigned long long)timing.min_setup,
+		(unsigned long long)timing.marginal_frames, timing.MinimumSafeSampleRate( NOMINAL_SAMPLE_RATE ) );
+
+	return sink.text + line;
+}
+
+static bool read_file( const std::string& path, std::string& text )
+{
+	std::ifstream file( path.c_str(), std::ios::in | std::ios::binary );
+	std::ostringstream contents;
+
+	if ( !file )
+		return false;
+
+	contents << file.rdbuf();
+	text = contents.str();
+	return true;
+}
+
+/* reports the first line at which 'actual' departs from 'expected' */
+static void report_difference( const char* name, const std::string& expected, const std::string& actual )
+{
+	std::istringstream e( expected ), a( actual );
+	std::string e_line, a_line;
+
+	for ( unsigned line = 1; ; line++ )
+	{
+		bool e_more = std::getline( e, e_line ) ? true : false;
+		bool a_more = std::getline( a, a_line ) ? true : false;
+
+		if ( !e_more && !a_more )
+			return;
+
+		if ( (e_more != a_more) || (e_line != a_line) )
+		{
+			printf( "FAIL %s line %u\n  expected: %s\n  actual:   %s\n", name, line, e_more ? e_line.c_str() : "<end>", a_more ? a_line.c_str() : "<end>" );
+			return;
+		}
+	}
+}
+
+static bool check_golden( const std::string& golden_dir, bool update )
+{
+	bool pass = true;
+
+	for ( unsigned i = 0; i < num_workloads; i++ )
+	{
+		std::string path = golden_dir + "/" + workloads[i].name + ".txt";
+		SWDLinkTiming timing;
+		std::string actual = run_workload( workloads[i], &timing );
+		std::string expected;
+
+		/* a link that decoded without a marginal frame was evidently captured fast enough */
+		if ( (0 == timing.marginal_frames) && (timing.MinimumSafeSampleRate( NOMINAL_SAMPLE_RATE ) > NOMINAL_SAMPLE_RATE) )
+		{
+			printf( "FAIL %s: no marginal frames, yet a minimum sample rate of %u\n", workloads[i].name, timing.MinimumSafeSampleRate( NOMINAL_SAMPLE_RATE ) );
+			pass = false;
+			continue;
+		}
+
+		if ( update )
+		{
+			std::ofstream file( path.c_str(), std::ios::out | std::ios::binary );
+			file << actual;
+			printf( "updated %s\n", path.c_str() );
+			continue;
+		}
+
+		if ( !read_file( path, expected ) )
+		{
+			printf( "FAIL %s: missing %s\n", workloads[i].name, path.c_str() );
+			pass = false;
+		}
+		else if ( expected != actual )
+		{
+			report_difference( workloads[i].name, expected, actual );
+			pass = false;
+		}
+		else
+		{
+			printf( "ok   %s\n", workloads[i].name );
+		}
+	}
+
+	return pass;
+}
+
+/* nothing, not even the tail of a frame that started earlier, may come out before the range */
+static bool starts_in_range( const std::string& text, uint64_t start_sample )
+{
+	std::istringstream lines( text );
+	std::string line;
+
+	while ( std::getline( lines, line ) )
+	{
+		unsigned long long sample = strtoull( line.c_str() + 2, 0, 10 );
+
+		if ( sample < start_sample )
+		{
+			printf( "FAIL resume: before the range: %s\n", line.c_str() );
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* a rerun that skips ahead to a checkpoint must give exactly what decoding from the start gives */
+static bool check_resume()
+{
+	const Workload& workload = workloads[2];
+	Waveform waveform( workload.half_period );
+	SWDCheckpoints checkpoints;
+
+	workload.build( waveform, 1 );
+
+	/* a range starting well after a checkpoint, part way through a transaction */
+	uint64_t start_sample = waveform.Now() / 2 + 5;
+
+	/* the first run over the capture takes the checkpoints */
+	TextSink first_sink;
+	SWDDecoder first( &first_sink );
+	TestHost first_host;
+	decode( waveform, first, first_host, 0, 0, &checkpoints );
+
+	TextSink fresh_sink;
+	SWDDecoder fresh( &fresh_sink );
+	TestHost fresh_host;
+	SWDCheckpoints none;
+	decode( waveform, fresh, fresh_host, start_sample, 0, &none );
+
+	TextSink resumed_sink;
+	SWDDecoder resumed( &resumed_sink );
+	TestHost resumed_host;
+	uint64_t resumed_at = decode( waveform, resumed, resumed_host, start_sample, 0, &checkpoints );
+
+	if ( fresh_sink.text.empty() || checkpoints.list.empty() || (checkpoints.list[0].sample >= start_sample) )
+	{
+		printf( "FAIL resume: workload too short for the test\n" );
+		return false;
+	}
+
+	if ( 0 == resumed_at )
+	{
+		printf( "FAIL resume: didn't skip ahead to a checkpoint\n" );
+		return false;
+	}
+
+	if ( !starts_in_range( fresh_sink.text, start_sample ) )
+		return false;
+
+	if ( fresh_sink.text != resumed_sink.text )
+	{
+		report_difference( "resume", fresh_sink.text, resumed_sink.text );
+		return false;
+	}
+
+	printf( "ok   resume\n" );
+	return true;
+}
+
+/* checkpoints from a capture that starts the same way as this one, but then differs, must not be resumed from */
+static bool check_foreign_checkpoints()
+{
+	Waveform original( 2 ), changed( 2 );
+	SWDCheckpoints checkpoints;
+
+	drw_burst_changed( original, 1, 0 );
+	drw_burst_changed( changed, 1, 0x00800000 );
+
+	TextSink original_sink;
+	SWDDecoder original_decoder( &original_sink );
+	TestHost original_host;
+	decode( original, original_decoder, original_host, 0, 0, &checkpoints );
+
+	/* a range starting after the first checkpoint, whose window falls among the changed writes */
+	uint64_t start_sample = changed.Now() / 2 + 5;
+
+	TextSink sink;
+	SWDDecoder decoder( &sink );
+	TestHost host;
+	uint64_t resumed_at = decode( changed, decoder, host, start_sample, 0, &checkpoints );
+
+	if ( checkpoints.list.empty() && (0 == checkpoints.fingerprint) && (0 == resumed_at) )
+	{
+		printf( "ok   foreign checkpoints\n" );
+		return true;
+	}
+
+	printf( "FAIL foreign checkpoints: resumed at rising edge %llu\n", (unsigned long long)resumed_at );
+	return false;
+}
+
+/* checkpoints from a longer capture must not have the walk wait for data past the end of this one */
+static bool check_short_capture()
+{
+	Waveform waveform( 2 );
+	SWDCheckpoints checkpoints;
+
+	drw_burst( waveform, 1 );
+
+	TextSink full_sink;
+	SWDDecoder full( &full_sink );
+	TestHost full_host;
+	decode( waveform, full, full_host, 0, 0, &checkpoints );
+
+	if ( checkpoints.list.size() < 2 )
+	{
+		printf( "FAIL short capture: workload too short for the test\n" );
+		return false;
+	}
+
+	/* the range starts after the last checkpoint, but the shorter capture stops before it */
+	uint64_t start_sample = waveform.Now() - 10;
+	waveform.Truncate( checkpoints.list.back().sample / 2 );
+
+	TextSink sink;
+	SWDDecoder decoder( &sink );
+	TestHost host;
+
+	try
+	{
+		decode( waveform, decoder, host, start_sample, 0, &checkpoints );
+	}
+	catch ( SeekPastEnd& )
+	{
+		printf( "FAIL short capture: sought past the end of the data\n" );
+		return false;
+	}
+
+	if ( !checkpoints.list.empty() )
+	{
+		printf( "FAIL short capture: kept checkpoints that aren't from this capture\n" );
+		return false;
+	}
+
+	printf( "ok   short capture\n" );
+	return true;
+}
+
+/*
+    A frame that starts inside the range comes out whole, even where it ends after the range;
+    nothing else does.  SWCLK is still followed to the end of the capture, for progress.
+*/
+static bool check_end_range()
+{
+	const Workload& workload = workloads[2];
+	Waveform waveform( workload.half_period );
+
+	workload.build( waveform, 1 );
+
+	TextSink full_sink;
+	SWDDecoder full( &full_sink );
+	TestHost full_host;
+	decode( waveform, full, full_host );
+
+	/* a range ending part way through the tenth transaction; the full output up to its frame is what's expected */
+	std::istringstream lines( full_sink.text );
+	std::string line, expected;
+	unsigned frames = 0;
+	uint64_t end_sample = 0;
+
+	while ( (frames < 10) && std::getline( lines, line ) )
+	{
+		expected += line + "\n";
+		if ( ('F' == line[0]) && (10 == ++frames) )
+			end_sample = strtoull( line.c_str() + 2, 0, 10 ) + 20;
+	}
+
+	TextSink sink;
+	SWDDecoder decoder( &sink );
+	TestHost host;
+	decode( waveform, decoder, host, 0, end_sample );
+
+	if ( sink.text != expected )
+	{
+		report_difference( "end range", expected, sink.text );
+		return false;
+	}
+
+	if ( (host.rising_edges != full_host.rising_edges) || (host.progress != full_host.progress) )
+	{
+		printf( "FAIL end range: progress stopped at %llu, not %llu\n", (unsigned long long)host.progress, (unsigned long long)full_host.progress );
+		return false;
+	}
+
+	printf( "ok   end range\n" );
+	return true;
+}
+
+/*
+    Runs in a process of its own, so that nothing one workload allocates is charged to another.
+    The memory reported is the heap the decode takes beyond the finished waveform, at its peak.
+*/
+static void benchmark_workload( const Workload& workload, unsigned scale )
+{
+	Waveform waveform( workload.half_period );
+	CountingSink sink;
+	SWDDecoder decoder( &sink );
+	TestHost host;
+
+	workload.build( waveform, scale );
+
+	size_t heap_before = heap_in_use;
+	heap_peak = heap_in_use;
+
+	clock_t start = clock();
+	decode( waveform, decoder, host, 0, 0, 0, SWD_CHECKPOINT_INTERVAL );
+	uint64_t edges = host.rising_edges;
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	if ( seconds <= 0 )
+		seconds = 1.0 / CLOCKS_PER_SEC;
+
+	printf( "%-14s %12llu %14.0f %12.0f %12.1f\n", workload.name, (unsigned long long)edges,
+		edges / seconds, sink.frames / seconds, (heap_peak - heap_before) / 1024.0 );
+}
+
+static bool benchmark( unsigned scale )
+{
+	bool pass = true;
+
+	printf( "%-14s %12s %14s %12s %12s\n", "workload", "edges", "edges/s", "frames/s", "decode KiB" );
+
+	for ( unsigned i = 0; i < num_workloads; i++ )
+	{
+		int status;
+
+		fflush( stdout );
+
+		pid_t child = fork();
+
+		if ( 0 == child )
+		{
+			benchmark_workload( workloads[i], scale );
+			fflush( stdout );
+			_exit( 0 );
+		}
+
+		if ( (child < 0) || (waitpid( child, &status, 0 ) != child) || !WIFEXITED( status ) || (0 != WEXITSTATUS( status )) )
+		{
+			printf( "FAIL %s: benchmark process failed\n", workloads[i].name );
+			pass = false;
+		}
+	}
+
+	return pass;
+}
+
+int main( int argc, char* argv[] )
+{
+	bool update = false, bench = false;
+	unsigned scale = 1000;
+
+	if ( argc < 2 )
+	{
+		fprintf( stderr, "usage: %s <golden directory> [--update] [--bench [scale]]\n", argv[0] );
+		return 2;
+	}
+
+	for ( int i = 2; i < argc; i++ )
+	{
+		if ( 0 == strcmp( argv[i], "--update" ) )
+			update = true;
+		else if ( 0 == strcmp( argv[i], "--bench" ) )
+		{
+			bench = true;
+			if ( (i + 1 < argc) && atoi( argv[i + 1] ) > 0 )
+				scale = atoi( argv[++i] );
+		}
+	}
+
+	if ( bench )
+		return (benchmark( scale )) ? 0 : 1;
+
+	bool pass = check_golden( argv[1], update );
+
+	if ( !update )
+	{
+		pass &= check_resume();
+		pass &= check_foreign_checkpoints();
+		pass &= check_short_capture();
+		pass &= check_end_range();
+	}
+
+	return (pass) ? 0 : 1;
+}